@@ -0,0 +1,126 @@
+//
+//  Arena.cpp
+//  FBXSceneFramework
+//
+//  Created by  Ivan Ushakov on 18/10/2026.
+//  Copyright © 2026  Ivan Ushakov. All rights reserved.
+//
+
+#include "Arena.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+Arena::Arena(size_t capacity) : capacity_(capacity), used_(0) {
+    if (capacity_ > 0) {
+        free_[0] = capacity_;
+    }
+}
+
+size_t Arena::allocate(size_t count) {
+    if (count == 0) {
+        throw std::runtime_error("");
+    }
+    
+    auto it = std::find_if(free_.begin(), free_.end(), [count](const std::pair<const size_t, size_t> &block) {
+        return block.second >= count;
+    });
+    
+    if (it == free_.end()) {
+        // Grow the tail, reusing the last free block if it touches the end of the arena.
+        size_t tail = capacity_;
+        if (!free_.empty()) {
+            auto last = std::prev(free_.end());
+            if (last->first + last->second == capacity_) {
+                tail = last->first;
+                free_.erase(last);
+            }
+        }
+        
+        const size_t newCapacity = std::max(2 * capacity_, tail + count);
+        if (tail + count < newCapacity) {
+            free_[tail + count] = newCapacity - tail - count;
+        }
+        capacity_ = newCapacity;
+        
+        blocks_[tail] = count;
+        used_ += count;
+        return tail;
+    }
+    
+    const size_t offset = it->first;
+    const size_t size = it->second;
+    free_.erase(it);
+    if (size > count) {
+        free_[offset + count] = size - count;
+    }
+    
+    blocks_[offset] = count;
+    used_ += count;
+    return offset;
+}
+
+void Arena::release(size_t offset) {
+    auto it = blocks_.find(offset);
+    if (it == blocks_.end()) {
+        throw std::runtime_error("");
+    }
+    
+    size_t start = it->first;
+    size_t size = it->second;
+    used_ -= size;
+    blocks_.erase(it);
+    
+    // Coalesce with the neighbours so large blocks can be reused.
+    auto next = free_.lower_bound(start);
+    if (next != free_.end() && start + size == next->first) {
+        size += next->second;
+        next = free_.erase(next);
+    }
+    
+    if (next != free_.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == start) {
+            start = previous->first;
+            size += previous->second;
+            free_.erase(previous);
+        }
+    }
+    
+    free_[start] = size;
+}
+
+std::vector<Arena::Move> Arena::defragment() {
+    std::vector<Move> moves;
+    std::map<size_t, size_t> blocks;
+    
+    size_t position = 0;
+    for (auto &&block : blocks_) {
+        if (block.first != position) {
+            moves.push_back(Move{block.first, position, block.second});
+        }
+        blocks[position] = block.second;
+        position += block.second;
+    }
+    
+    blocks_.swap(blocks);
+    free_.clear();
+    if (position < capacity_) {
+        free_[position] = capacity_ - position;
+    }
+    
+    return moves;
+}
+
+size_t Arena::capacity() const {
+    return capacity_;
+}
+
+size_t Arena::used() const {
+    return used_;
+}
+
+size_t Arena::blockCount() const {
+    return blocks_.size();
+}
@@ -0,0 +1,45 @@
+//
+//  Arena.h
+//  FBXSceneFramework
+//
+//  Created by  Ivan Ushakov on 18/10/2026.
+//  Copyright © 2026  Ivan Ushakov. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// Suballocator for one shared buffer. Offsets and sizes are counted in elements.
+class Arena {
+public:
+    struct Move {
+        size_t from;
+        size_t to;
+        size_t count;
+    };
+    
+    explicit Arena(size_t capacity = 0);
+    
+    // Returns the offset of a free block, the arena grows if no block is large enough.
+    size_t allocate(size_t count);
+    
+    void release(size_t offset);
+    
+    // Packs all blocks to the start of the arena. Moves must be applied in order.
+    std::vector<Move> defragment();
+    
+    size_t capacity() const;
+    
+    size_t used() const;
+    
+    size_t blockCount() const;
+
+private:
+    std::map<size_t, size_t> blocks_;
+    std::map<size_t, size_t> free_;
+    size_t capacity_;
+    size_t used_;
+};
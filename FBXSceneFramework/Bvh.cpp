@@ -0,0 +1,505 @@
+//
+//  Bvh.cpp
+//  FBXSceneFramework
+//
+//  Created by  Ivan Ushakov on 18/10/2026.
+//  Copyright © 2026  Ivan Ushakov. All rights reserved.
+//
+
+#include "Bvh.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+const uint32_t Bvh::NoTriangle = UINT32_MAX;
+
+static const uint32_t BinCount = 16;
+static const uint32_t MinLeafSize = 2;
+static const uint32_t MaxLeafSize = 8;
+static const uint32_t MaxDepth = 48;
+// Traversal stack, a tree of MaxDepth levels never needs more.
+static const uint32_t StackSize = 64;
+
+// Four rays in structure of arrays layout, one ray per lane.
+struct RayPacket {
+    simd_float4 origin[3];
+    simd_float4 direction[3];
+    simd_float4 inverse[3];
+    simd_float4 distance;
+    simd_float4 u;
+    simd_float4 v;
+    simd_int4 triangle;
+};
+
+struct Bounds {
+    simd_float3 min;
+    simd_float3 max;
+};
+
+static Bounds makeEmptyBounds() {
+    return Bounds{simd_float3 {FLT_MAX, FLT_MAX, FLT_MAX}, simd_float3 {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+}
+
+static void grow(Bounds &bounds, const simd_float3 &point) {
+    bounds.min = simd_min(bounds.min, point);
+    bounds.max = simd_max(bounds.max, point);
+}
+
+static void grow(Bounds &bounds, const Bounds &other) {
+    bounds.min = simd_min(bounds.min, other.min);
+    bounds.max = simd_max(bounds.max, other.max);
+}
+
+static float surfaceArea(const Bounds &bounds) {
+    if (bounds.min[0] > bounds.max[0]) {
+        return 0.0f;
+    }
+    
+    const simd_float3 d = bounds.max - bounds.min;
+    return 2.0f * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+}
+
+static simd_float4 broadcast(float value) {
+    return simd_float4 {value, value, value, value};
+}
+
+// Zero direction components are nudged so the slab test never computes 0 * inf.
+static float inverseDirection(float value) {
+    const float epsilon = 1e-20f;
+    return 1.0f / (std::fabs(value) > epsilon ? value : std::copysign(epsilon, value));
+}
+
+static bool intersectBox(const BvhNode &node, const simd_float3 &origin, const simd_float3 &inverse, float distance, float &near) {
+    float tmin = 0.0f;
+    float tmax = distance;
+    for (int axis = 0; axis < 3; axis++) {
+        const float t0 = (node.minBounds[axis] - origin[axis]) * inverse[axis];
+        const float t1 = (node.maxBounds[axis] - origin[axis]) * inverse[axis];
+        tmin = std::max(tmin, std::min(t0, t1));
+        tmax = std::min(tmax, std::max(t0, t1));
+    }
+    
+    near = tmin;
+    return tmin <= tmax;
+}
+
+static simd_int4 intersectBox(const BvhNode &node, const RayPacket &packet) {
+    simd_float4 tmin = broadcast(0.0f);
+    simd_float4 tmax = packet.distance;
+    for (int axis = 0; axis < 3; axis++) {
+        const simd_float4 t0 = (broadcast(node.minBounds[axis]) - packet.origin[axis]) * packet.inverse[axis];
+        const simd_float4 t1 = (broadcast(node.maxBounds[axis]) - packet.origin[axis]) * packet.inverse[axis];
+        tmin = simd_max(tmin, simd_min(t0, t1));
+        tmax = simd_min(tmax, simd_max(t0, t1));
+    }
+    
+    return tmin <= tmax;
+}
+
+void Bvh::build(const simd_float3 *positions, size_t stride, const uint32_t *indices, size_t indexCount) {
+    setGeometry(positions, stride, indices);
+    
+    const uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+    
+    nodes_.clear();
+    triangles_.resize(triangleCount);
+    for (uint32_t i = 0; i < triangleCount; i++) {
+        triangles_[i] = i;
+    }
+    
+    if (triangleCount == 0) {
+        return;
+    }
+    
+    std::vector<simd_float3> centroids(triangleCount);
+    for (uint32_t i = 0; i < triangleCount; i++) {
+        centroids[i] = (position(indices_[3 * i]) + position(indices_[3 * i + 1]) + position(indices_[3 * i + 2])) / 3.0f;
+    }
+    
+    // A binary tree with one triangle per leaf has 2n - 1 nodes.
+    nodes_.reserve(2 * triangleCount - 1);
+    nodes_.push_back(BvhNode());
+    buildRecursive(0, 0, triangleCount, 0, centroids);
+    nodes_.shrink_to_fit();
+}
+
+void Bvh::setGeometry(const simd_float3 *positions, size_t stride, const uint32_t *indices) {
+    positions_ = reinterpret_cast<const char *>(positions);
+    stride_ = stride;
+    indices_ = indices;
+}
+
+void Bvh::refit() {
+    // Children are always stored after their parent.
+    for (size_t i = nodes_.size(); i > 0; i--) {
+        computeBounds(static_cast<uint32_t>(i - 1));
+    }
+}
+
+bool Bvh::intersect(const Ray &ray, RayHit &hit) const {
+    if (nodes_.empty()) {
+        return false;
+    }
+    
+    const simd_float3 inverse = simd_float3 {
+        inverseDirection(ray.direction[0]),
+        inverseDirection(ray.direction[1]),
+        inverseDirection(ray.direction[2])
+    };
+    
+    uint32_t stack[StackSize];
+    float stackNear[StackSize];
+    size_t size = 0;
+    
+    float near;
+    if (!intersectBox(nodes_[0], ray.origin, inverse, hit.distance, near)) {
+        return false;
+    }
+    
+    stack[size] = 0;
+    stackNear[size++] = near;
+    
+    bool found = false;
+    while (size > 0) {
+        size--;
+        const uint32_t index = stack[size];
+        if (stackNear[size] > hit.distance) {
+            continue;
+        }
+        
+        const BvhNode &node = nodes_[index];
+        if (node.count > 0) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                found |= intersectTriangle(triangles_[i], ray, hit);
+            }
+            continue;
+        }
+        
+        float leftNear;
+        float rightNear;
+        const bool left = intersectBox(nodes_[index + 1], ray.origin, inverse, hit.distance, leftNear);
+        const bool right = intersectBox(nodes_[node.offset], ray.origin, inverse, hit.distance, rightNear);
+        
+        // Push the far child first so the near one is visited first.
+        if (left && right && leftNear > rightNear) {
+            stack[size] = index + 1;
+            stackNear[size++] = leftNear;
+            stack[size] = node.offset;
+            stackNear[size++] = rightNear;
+        } else {
+            if (right) {
+                stack[size] = node.offset;
+                stackNear[size++] = rightNear;
+            }
+            if (left) {
+                stack[size] = index + 1;
+                stackNear[size++] = leftNear;
+            }
+        }
+    }
+    
+    return found;
+}
+
+void Bvh::intersect(const Ray *rays, RayHit *hits, size_t count) const {
+    if (nodes_.empty()) {
+        return;
+    }
+    
+    for (size_t first = 0; first < count; first += 4) {
+        const size_t laneCount = std::min<size_t>(4, count - first);
+        
+        RayPacket packet;
+        packet.u = broadcast(0.0f);
+        packet.v = broadcast(0.0f);
+        packet.triangle = simd_int4 {-1, -1, -1, -1};
+        
+        for (size_t lane = 0; lane < 4; lane++) {
+            if (lane < laneCount) {
+                const Ray &ray = rays[first + lane];
+                for (int axis = 0; axis < 3; axis++) {
+                    packet.origin[axis][lane] = ray.origin[axis];
+                    packet.direction[axis][lane] = ray.direction[axis];
+                    packet.inverse[axis][lane] = inverseDirection(ray.direction[axis]);
+                }
+                packet.distance[lane] = hits[first + lane].distance;
+            } else {
+                // A negative distance keeps the unused lanes out of every test.
+                for (int axis = 0; axis < 3; axis++) {
+                    packet.origin[axis][lane] = 0.0f;
+                    packet.direction[axis][lane] = 1.0f;
+                    packet.inverse[axis][lane] = 1.0f;
+                }
+                packet.distance[lane] = -1.0f;
+            }
+        }
+        
+        intersectPacket(packet);
+        
+        for (size_t lane = 0; lane < laneCount; lane++) {
+            if (packet.triangle[lane] == -1) {
+                continue;
+            }
+            
+            RayHit &hit = hits[first + lane];
+            hit.triangle = static_cast<uint32_t>(packet.triangle[lane]);
+            hit.barycentrics = simd_float2 {packet.u[lane], packet.v[lane]};
+            hit.distance = packet.distance[lane];
+        }
+    }
+}
+
+const std::vector<BvhNode> &Bvh::nodes() const {
+    return nodes_;
+}
+
+size_t Bvh::triangleCount() const {
+    return triangles_.size();
+}
+
+size_t Bvh::memorySize() const {
+    return nodes_.capacity() * sizeof(BvhNode) + triangles_.capacity() * sizeof(uint32_t);
+}
+
+const simd_float3 &Bvh::position(uint32_t index) const {
+    return *reinterpret_cast<const simd_float3 *>(positions_ + index * stride_);
+}
+
+void Bvh::buildRecursive(uint32_t index, uint32_t begin, uint32_t end, uint32_t depth, const std::vector<simd_float3> &centroids) {
+    nodes_[index].offset = begin;
+    nodes_[index].count = end - begin;
+    computeBounds(index);
+    
+    const uint32_t count = end - begin;
+    if (count <= MinLeafSize || depth >= MaxDepth) {
+        return;
+    }
+    
+    Bounds centroidBounds = makeEmptyBounds();
+    for (uint32_t i = begin; i < end; i++) {
+        grow(centroidBounds, centroids[triangles_[i]]);
+    }
+    
+    // Binned surface area heuristic, the cost of a split is the area weighted triangle count of both sides.
+    float bestCost = FLT_MAX;
+    int bestAxis = -1;
+    uint32_t bestSplit = 0;
+    
+    for (int axis = 0; axis < 3; axis++) {
+        const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+        if (extent <= 0.0f) {
+            continue;
+        }
+        
+        const float scale = BinCount / extent;
+        
+        uint32_t binCount[BinCount] = {};
+        Bounds binBounds[BinCount];
+        std::fill(binBounds, binBounds + BinCount, makeEmptyBounds());
+        
+        for (uint32_t i = begin; i < end; i++) {
+            const uint32_t triangle = triangles_[i];
+            const uint32_t bin = std::min(BinCount - 1, static_cast<uint32_t>((centroids[triangle][axis] - centroidBounds.min[axis]) * scale));
+            binCount[bin]++;
+            for (int k = 0; k < 3; k++) {
+                grow(binBounds[bin], position(indices_[3 * triangle + k]));
+            }
+        }
+        
+        float rightArea[BinCount];
+        uint32_t rightCount[BinCount];
+        Bounds bounds = makeEmptyBounds();
+        uint32_t sum = 0;
+        for (uint32_t bin = BinCount - 1; bin > 0; bin--) {
+            grow(bounds, binBounds[bin]);
+            sum += binCount[bin];
+            rightArea[bin] = surfaceArea(bounds);
+            rightCount[bin] = sum;
+        }
+        
+        bounds = makeEmptyBounds();
+        sum = 0;
+        for (uint32_t bin = 0; bin < BinCount - 1; bin++) {
+            grow(bounds, binBounds[bin]);
+            sum += binCount[bin];
+            
+            const float cost = sum * surfaceArea(bounds) + rightCount[bin + 1] * rightArea[bin + 1];
+            if (sum > 0 && rightCount[bin + 1] > 0 && cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = bin;
+            }
+        }
+    }
+    
+    if (bestAxis < 0) {
+        return;
+    }
+    
+    // Traversal and intersection are assumed to cost the same.
+    const BvhNode &node = nodes_[index];
+    const Bounds nodeBounds = {
+        simd_float3 {node.minBounds[0], node.minBounds[1], node.minBounds[2]},
+        simd_float3 {node.maxBounds[0], node.maxBounds[1], node.maxBounds[2]}
+    };
+    const float splitCost = 1.0f + bestCost / std::max(surfaceArea(nodeBounds), FLT_MIN);
+    if (splitCost >= count && count <= MaxLeafSize) {
+        return;
+    }
+    
+    const float scale = BinCount / (centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis]);
+    const float minCentroid = centroidBounds.min[bestAxis];
+    auto middle = std::partition(triangles_.begin() + begin, triangles_.begin() + end, [&](uint32_t triangle) {
+        const uint32_t bin = std::min(BinCount - 1, static_cast<uint32_t>((centroids[triangle][bestAxis] - minCentroid) * scale));
+        return bin <= bestSplit;
+    });
+    
+    const uint32_t split = static_cast<uint32_t>(middle - triangles_.begin());
+    
+    nodes_[index].count = 0;
+    
+    const uint32_t left = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back(BvhNode());
+    buildRecursive(left, begin, split, depth + 1, centroids);
+    
+    const uint32_t right = static_cast<uint32_t>(nodes_.size());
+    nodes_[index].offset = right;
+    nodes_.push_back(BvhNode());
+    buildRecursive(right, split, end, depth + 1, centroids);
+}
+
+void Bvh::computeBounds(uint32_t index) {
+    BvhNode &node = nodes_[index];
+    
+    Bounds bounds = makeEmptyBounds();
+    if (node.count > 0) {
+        for (uint32_t i = node.offset; i < node.offset + node.count; i++) {
+            const uint32_t triangle = triangles_[i];
+            for (int k = 0; k < 3; k++) {
+                grow(bounds, position(indices_[3 * triangle + k]));
+            }
+        }
+    } else {
+        for (uint32_t child : {index + 1, node.offset}) {
+            const BvhNode &n = nodes_[child];
+            grow(bounds, Bounds{
+                simd_float3 {n.minBounds[0], n.minBounds[1], n.minBounds[2]},
+                simd_float3 {n.maxBounds[0], n.maxBounds[1], n.maxBounds[2]}
+            });
+        }
+    }
+    
+    for (int axis = 0; axis < 3; axis++) {
+        node.minBounds[axis] = bounds.min[axis];
+        node.maxBounds[axis] = bounds.max[axis];
+    }
+}
+
+// Moller-Trumbore, both faces are hit.
+bool Bvh::intersectTriangle(uint32_t triangle, const Ray &ray, RayHit &hit) const {
+    const simd_float3 &v0 = position(indices_[3 * triangle]);
+    const simd_float3 &v1 = position(indices_[3 * triangle + 1]);
+    const simd_float3 &v2 = position(indices_[3 * triangle + 2]);
+    
+    const simd_float3 e1 = v1 - v0;
+    const simd_float3 e2 = v2 - v0;
+    
+    const simd_float3 p = simd_cross(ray.direction, e2);
+    const float det = simd_dot(e1, p);
+    if (det == 0.0f) {
+        return false;
+    }
+    
+    const float inverse = 1.0f / det;
+    
+    const simd_float3 s = ray.origin - v0;
+    const float u = simd_dot(s, p) * inverse;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    
+    const simd_float3 q = simd_cross(s, e1);
+    const float v = simd_dot(ray.direction, q) * inverse;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    
+    const float t = simd_dot(e2, q) * inverse;
+    if (t <= 0.0f || t >= hit.distance) {
+        return false;
+    }
+    
+    hit.triangle = triangle;
+    hit.barycentrics = simd_float2 {u, v};
+    hit.distance = t;
+    return true;
+}
+
+void Bvh::intersectTriangle(uint32_t triangle, RayPacket &packet) const {
+    const simd_float3 &v0 = position(indices_[3 * triangle]);
+    const simd_float3 &v1 = position(indices_[3 * triangle + 1]);
+    const simd_float3 &v2 = position(indices_[3 * triangle + 2]);
+    
+    const simd_float3 e1 = v1 - v0;
+    const simd_float3 e2 = v2 - v0;
+    
+    const simd_float4 *d = packet.direction;
+    
+    const simd_float4 px = d[1] * e2[2] - d[2] * e2[1];
+    const simd_float4 py = d[2] * e2[0] - d[0] * e2[2];
+    const simd_float4 pz = d[0] * e2[1] - d[1] * e2[0];
+    
+    const simd_float4 det = e1[0] * px + e1[1] * py + e1[2] * pz;
+    const simd_float4 inverse = broadcast(1.0f) / det;
+    
+    const simd_float4 sx = packet.origin[0] - v0[0];
+    const simd_float4 sy = packet.origin[1] - v0[1];
+    const simd_float4 sz = packet.origin[2] - v0[2];
+    
+    const simd_float4 u = (sx * px + sy * py + sz * pz) * inverse;
+    
+    const simd_float4 qx = sy * e1[2] - sz * e1[1];
+    const simd_float4 qy = sz * e1[0] - sx * e1[2];
+    const simd_float4 qz = sx * e1[1] - sy * e1[0];
+    
+    const simd_float4 v = (d[0] * qx + d[1] * qy + d[2] * qz) * inverse;
+    const simd_float4 t = (e2[0] * qx + e2[1] * qy + e2[2] * qz) * inverse;
+    
+    const simd_int4 mask = (det != 0.0f) & (u >= 0.0f) & (v >= 0.0f) & (u + v <= 1.0f) & (t > 0.0f) & (t < packet.distance);
+    if (!simd_any(mask)) {
+        return;
+    }
+    
+    packet.distance = simd_select(packet.distance, t, mask);
+    packet.u = simd_select(packet.u, u, mask);
+    packet.v = simd_select(packet.v, v, mask);
+    
+    const int id = static_cast<int>(triangle);
+    packet.triangle = simd_bitselect(packet.triangle, simd_int4 {id, id, id, id}, mask);
+}
+
+void Bvh::intersectPacket(RayPacket &packet) const {
+    uint32_t stack[StackSize];
+    size_t size = 0;
+    stack[size++] = 0;
+    
+    while (size > 0) {
+        const uint32_t index = stack[--size];
+        const BvhNode &node = nodes_[index];
+        
+        // The node is skipped only when it is missed by every ray of the packet.
+        if (!simd_any(intersectBox(node, packet))) {
+            continue;
+        }
+        
+        if (node.count > 0) {
+            for (uint32_t i = node.offset; i < node.offset + node.count; i++) {
+                intersectTriangle(triangles_[i], packet);
+            }
+        } else {
+            stack[size++] = node.offset;
+            stack[size++] = index + 1;
+        }
+    }
+}
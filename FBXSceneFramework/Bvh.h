@@ -0,0 +1,86 @@
+//
+//  Bvh.h
+//  FBXSceneFramework
+//
+//  Created by  Ivan Ushakov on 18/10/2026.
+//  Copyright © 2026  Ivan Ushakov. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <simd/simd.h>
+
+// Distances are measured in lengths of the direction vector.
+struct Ray {
+    simd_float3 origin;
+    simd_float3 direction;
+    float maxDistance;
+};
+
+struct RayHit {
+    int mesh;
+    uint32_t triangle;
+    simd_float2 barycentrics;
+    float distance;
+};
+
+struct RayPacket;
+
+// Node of the flattened tree. The left child of an inner node directly follows it.
+struct BvhNode {
+    float minBounds[3];
+    uint32_t offset; // first triangle of a leaf, right child of an inner node
+    float maxBounds[3];
+    uint32_t count; // triangles in a leaf, 0 for an inner node
+};
+
+// Bounding volume hierarchy over one triangle mesh, built with the surface area heuristic.
+class Bvh {
+public:
+    static const uint32_t NoTriangle;
+    
+    // Positions are read with a byte stride. The geometry is referenced, not copied,
+    // and has to stay alive until it is replaced with setGeometry.
+    void build(const simd_float3 *, size_t, const uint32_t *, size_t);
+    
+    // Points the tree at another copy of the geometry it was built from.
+    void setGeometry(const simd_float3 *, size_t, const uint32_t *);
+    
+    // Reads the current positions and updates the node bounds, the tree itself is kept.
+    void refit();
+    
+    // Hits are only written when they are closer than hit.distance, mesh is left untouched.
+    bool intersect(const Ray &, RayHit &) const;
+    
+    // Same as above for a batch, rays are traced in packets of four.
+    void intersect(const Ray *, RayHit *, size_t) const;
+    
+    const std::vector<BvhNode> &nodes() const;
+    
+    size_t triangleCount() const;
+    
+    size_t memorySize() const;
+
+private:
+    void buildRecursive(uint32_t, uint32_t, uint32_t, uint32_t, const std::vector<simd_float3> &);
+    
+    const simd_float3 &position(uint32_t) const;
+    
+    void computeBounds(uint32_t);
+    
+    bool intersectTriangle(uint32_t, const Ray &, RayHit &) const;
+    
+    void intersectTriangle(uint32_t, RayPacket &) const;
+    
+    void intersectPacket(RayPacket &) const;
+    
+    std::vector<BvhNode> nodes_;
+    std::vector<uint32_t> triangles_;
+    const uint32_t *indices_ = nullptr;
+    const char *positions_ = nullptr;
+    size_t stride_ = 0;
+};
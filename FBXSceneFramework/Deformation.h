@@ -22,10 +22,4 @@ namespace fbx
     
     // Compute the transform matrix that the cluster will transform the vertex.
     void ComputeClusterDeformation(const FbxAMatrix &, FbxMesh *, FbxCluster *, FbxAMatrix &, const FbxTime &);
-    
-    // Deform the vertex array in classic linear way.
-    void ComputeLinearDeformation(const FbxAMatrix &, FbxMesh *, const FbxTime &, FbxVector4 *);
-    
-    // Deform the vertex array according to the links contained in the mesh and the skinning type.
-    void ComputeSkinDeformation(const FbxAMatrix &, FbxMesh *, const FbxTime &, FbxVector4 *);
 }
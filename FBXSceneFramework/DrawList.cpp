@@ -0,0 +1,50 @@
+//
+//  DrawList.cpp
+//  FBXSceneFramework
+//
+//  Created by  Ivan Ushakov on 18/10/2026.
+//  Copyright © 2026  Ivan Ushakov. All rights reserved.
+//
+
+#include "DrawList.h"
+
+#include <algorithm>
+#include <iterator>
+
+const uint32_t DrawList::NoMaterial = UINT32_MAX;
+
+void DrawList::build(const std::vector<DrawItem> &items) {
+    items_.clear();
+    items_.reserve(items.size());
+    
+    std::copy_if(items.begin(), items.end(), std::back_inserter(items_), [](const DrawItem &item) {
+        return item.material != NoMaterial && item.indexCount > 0;
+    });
+    
+    // Keep the arena order inside one material, it is the order the data sits in the buffers.
+    std::stable_sort(items_.begin(), items_.end(), [](const DrawItem &a, const DrawItem &b) {
+        if (a.material != b.material) {
+            return a.material < b.material;
+        }
+        return a.indexOffset < b.indexOffset;
+    });
+    
+    materialBindCount_ = 0;
+    for (size_t i = 0; i < items_.size(); i++) {
+        if (i == 0 || items_[i].material != items_[i - 1].material) {
+            materialBindCount_++;
+        }
+    }
+}
+
+const std::vector<DrawItem> &DrawList::items() const {
+    return items_;
+}
+
+size_t DrawList::drawCount() const {
+    return items_.size();
+}
+
+size_t DrawList::materialBindCount() const {
+    return materialBindCount_;
+}
@@ -0,0 +1,41 @@
+//
+//  DrawList.h
+//  FBXSceneFramework
+//
+//  Created by  Ivan Ushakov on 18/10/2026.
+//  Copyright © 2026  Ivan Ushakov. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct DrawItem {
+    uint32_t mesh;
+    uint32_t material;
+    size_t indexCount;
+    size_t indexOffset;
+    size_t baseVertex;
+};
+
+// Draws sorted by material. The position of an item in the list is the index of its uniforms.
+class DrawList {
+public:
+    static const uint32_t NoMaterial;
+    
+    // Items without a material or indices are dropped.
+    void build(const std::vector<DrawItem> &);
+    
+    const std::vector<DrawItem> &items() const;
+    
+    size_t drawCount() const;
+    
+    // Number of material changes when the list is drawn in order.
+    size_t materialBindCount() const;
+
+private:
+    std::vector<DrawItem> items_;
+    size_t materialBindCount_ = 0;
+};
@@ -13,6 +13,35 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+FOUNDATION_EXPORT const uint32_t FBXSceneNoMaterial;
+
+// Bytes held by the scene, peakLoad is the high water mark of load:error:.
+// geometry includes the vertex and index buffers made by createBuffers:error:.
+// FBX SDK memory is tracked for the whole process: transient and peakLoad include
+// allocations of every scene or importer alive at the time, not only this one.
+typedef struct {
+    size_t geometry;
+    size_t animation;
+    size_t skin;
+    size_t transient;
+    size_t peakLoad;
+} FBXSceneMemoryUsage;
+
+// World space ray, distances are measured in lengths of the direction vector.
+typedef struct {
+    simd_float3 origin;
+    simd_float3 direction;
+    float maxDistance;
+} FBXSceneRay;
+
+// mesh is -1 when nothing was hit.
+typedef struct {
+    NSInteger mesh;
+    uint32_t triangle;
+    simd_float2 barycentrics;
+    float distance;
+} FBXSceneRayHit;
+
 @interface FBXScene : NSObject
 
 @property (readonly, nonatomic) NSString *path;
@@ -29,9 +58,31 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (simd_float4x4)getTransformation:(size_t)index;
 
-- (id <MTLBuffer>)getVertexBuffer:(size_t)index;
+- (id <MTLBuffer>)getVertexBuffer;
+
+- (id <MTLBuffer>)getIndexBuffer;
+
+- (size_t)getBaseVertex:(size_t)index;
+
+- (size_t)getIndexBufferOffset:(size_t)index;
+
+// Sorts the meshes by material id, meshes with FBXSceneNoMaterial are not drawn.
+- (void)buildDrawList:(NSArray<NSNumber *> *)materials;
+
+- (size_t)getDrawCount;
+
+- (size_t)getDrawMesh:(size_t)index;
+
+- (uint32_t)getDrawMaterial:(size_t)index;
+
+- (size_t)getMaterialBindCount;
+
+- (FBXSceneMemoryUsage)getMemoryUsage;
+
+// Queries see the geometry of the last render call and must not run concurrently with it.
+- (BOOL)intersectRay:(FBXSceneRay)ray hit:(FBXSceneRayHit *)hit;
 
-- (id <MTLBuffer>)getIndexBuffer:(size_t)index;
+- (void)intersectRays:(const FBXSceneRay *)rays hits:(FBXSceneRayHit *)hits count:(size_t)count;
 
 - (NSString *)getName:(size_t)index;
 
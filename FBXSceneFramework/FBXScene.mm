@@ -10,10 +10,16 @@
 
 #import "Scene.h"
 
+const uint32_t FBXSceneNoMaterial = DrawList::NoMaterial;
+
+static FBXSceneRayHit makeRayHit(const RayHit &hit) {
+    return FBXSceneRayHit{hit.mesh, hit.triangle, hit.barycentrics, hit.distance};
+}
+
 @implementation FBXScene
 {
-    NSMutableArray<id <MTLBuffer>> *_vertexBuffers;
-    NSMutableArray<id <MTLBuffer>> *_indexBuffers;
+    id <MTLBuffer> _vertexBuffer;
+    id <MTLBuffer> _indexBuffer;
     Scene _scene;
 }
 
@@ -28,31 +34,40 @@
 }
 
 - (BOOL)createBuffers:(id <MTLDevice>)device error:(NSError * _Nullable * _Nullable)error {
-    _vertexBuffers = [NSMutableArray arrayWithCapacity:_scene.mesh_.size()];
-    _indexBuffers = [NSMutableArray arrayWithCapacity:_scene.mesh_.size()];
+    // The CPU copy of the static geometry is gone after the first upload.
+    if (_vertexBuffer != nil) {
+        return YES;
+    }
+    
+    _scene.allocateGeometry();
     
+    NSUInteger l1 = std::max<size_t>(_scene.vertexArena_.capacity(), 1) * sizeof(Vertex);
+    id <MTLBuffer> vertexBuffer = [device newBufferWithLength:l1 options:MTLResourceStorageModeShared];
+    if (vertexBuffer == nil) {
+        *error = nil;
+        return NO;
+    }
+    
+    NSUInteger l2 = std::max<size_t>(_scene.indexArena_.capacity(), 1) * sizeof(uint32_t);
+    id <MTLBuffer> indexBuffer = [device newBufferWithLength:l2 options:MTLResourceStorageModeShared];
+    if (indexBuffer == nil) {
+        *error = nil;
+        return NO;
+    }
+    
+    Vertex *vertexArray = (Vertex *)vertexBuffer.contents;
+    uint32_t *indexArray = (uint32_t *)indexBuffer.contents;
     for (auto &&m : _scene.mesh_) {
-        NSUInteger l1 = m->vertexCount * sizeof(Vertex);
-        id <MTLBuffer> vertexBuffer = [device newBufferWithLength:l1 options:MTLResourceStorageModeShared];
-        if (vertexBuffer == nil) {
-            *error = nil;
-            return NO;
-        }
-        
-        [_vertexBuffers addObject:vertexBuffer];
-        m->vertexArray = (Vertex *)vertexBuffer.contents;
-        
-        NSUInteger l2 = m->indexCount * sizeof(uint32_t);
-        id <MTLBuffer> indexBuffer = [device newBufferWithLength:l2 options:MTLResourceStorageModeShared];
-        if (indexBuffer == nil) {
-            *error = nil;
-            return NO;
-        }
-        
-        [_indexBuffers addObject:indexBuffer];
-        m->indexArray = (uint32_t *)indexBuffer.contents;
+        m->vertexArray = vertexArray + m->baseVertex;
+        m->indexArray = indexArray + m->indexOffset;
     }
     
+    _scene.uploadGeometry();
+    
+    // Only set once the upload is done, so a failed attempt can be retried.
+    _vertexBuffer = vertexBuffer;
+    _indexBuffer = indexBuffer;
+    
     return YES;
 }
 
@@ -73,12 +88,71 @@
     return _scene.mesh_[index]->position;
 }
 
-- (id <MTLBuffer>)getVertexBuffer:(size_t)index {
-    return _vertexBuffers[index];
+- (id <MTLBuffer>)getVertexBuffer {
+    return _vertexBuffer;
+}
+
+- (id <MTLBuffer>)getIndexBuffer {
+    return _indexBuffer;
+}
+
+- (size_t)getBaseVertex:(size_t)index {
+    return _scene.mesh_[index]->baseVertex;
+}
+
+- (size_t)getIndexBufferOffset:(size_t)index {
+    return _scene.mesh_[index]->indexOffset * sizeof(uint32_t);
 }
 
-- (id <MTLBuffer>)getIndexBuffer:(size_t)index {
-    return _indexBuffers[index];
+- (void)buildDrawList:(NSArray<NSNumber *> *)materials {
+    std::vector<uint32_t> ids;
+    ids.reserve(materials.count);
+    for (NSNumber *material in materials) {
+        ids.push_back(material.unsignedIntValue);
+    }
+    _scene.buildDrawList(ids);
+}
+
+- (size_t)getDrawCount {
+    return _scene.drawList_.drawCount();
+}
+
+- (size_t)getDrawMesh:(size_t)index {
+    return _scene.drawList_.items()[index].mesh;
+}
+
+- (uint32_t)getDrawMaterial:(size_t)index {
+    return _scene.drawList_.items()[index].material;
+}
+
+- (size_t)getMaterialBindCount {
+    return _scene.drawList_.materialBindCount();
+}
+
+- (FBXSceneMemoryUsage)getMemoryUsage {
+    const MemoryUsage usage = _scene.memoryUsage();
+    return FBXSceneMemoryUsage{usage.geometry, usage.animation, usage.skin, usage.transient, usage.peakLoad};
+}
+
+- (BOOL)intersectRay:(FBXSceneRay)ray hit:(FBXSceneRayHit *)hit {
+    RayHit result;
+    const bool found = _scene.intersect(Ray{ray.origin, ray.direction, ray.maxDistance}, result);
+    *hit = makeRayHit(result);
+    return found;
+}
+
+- (void)intersectRays:(const FBXSceneRay *)rays hits:(FBXSceneRayHit *)hits count:(size_t)count {
+    std::vector<Ray> batch(count);
+    for (size_t i = 0; i < count; i++) {
+        batch[i] = Ray{rays[i].origin, rays[i].direction, rays[i].maxDistance};
+    }
+    
+    std::vector<RayHit> results;
+    _scene.intersect(batch, results);
+    
+    for (size_t i = 0; i < count; i++) {
+        hits[i] = makeRayHit(results[i]);
+    }
 }
 
 - (NSString *)getName:(size_t)index {
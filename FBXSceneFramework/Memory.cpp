@@ -0,0 +1,91 @@
+//
+//  Memory.cpp
+//  FBXSceneFramework
+//
+//  Created by  Ivan Ushakov on 18/10/2026.
+//  Copyright © 2026  Ivan Ushakov. All rights reserved.
+//
+
+#include "Memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+#include <malloc/malloc.h>
+
+#include <fbxsdk.h>
+
+namespace memory
+{
+    // Signed, blocks allocated before install() may be freed through the counters.
+    static std::atomic<long long> currentBytes(0);
+    static std::atomic<long long> peakBytes(0);
+    
+    static void add(void *pointer) {
+        if (pointer == nullptr) {
+            return;
+        }
+        
+        const long long size = malloc_size(pointer);
+        const long long value = currentBytes.fetch_add(size) + size;
+        long long previous = peakBytes.load();
+        while (previous < value && !peakBytes.compare_exchange_weak(previous, value)) {}
+    }
+    
+    static void remove(void *pointer) {
+        if (pointer == nullptr) {
+            return;
+        }
+        
+        currentBytes.fetch_sub(static_cast<long long>(malloc_size(pointer)));
+    }
+    
+    static void *trackedMalloc(size_t size) {
+        void *pointer = malloc(size);
+        add(pointer);
+        return pointer;
+    }
+    
+    static void *trackedCalloc(size_t count, size_t size) {
+        void *pointer = calloc(count, size);
+        add(pointer);
+        return pointer;
+    }
+    
+    static void *trackedRealloc(void *pointer, size_t size) {
+        remove(pointer);
+        void *result = realloc(pointer, size);
+        // On failure the old block is still alive.
+        add(result == nullptr && size > 0 ? pointer : result);
+        return result;
+    }
+    
+    static void trackedFree(void *pointer) {
+        remove(pointer);
+        free(pointer);
+    }
+    
+    void install() {
+        static std::once_flag installed;
+        std::call_once(installed, [] {
+            FbxSetMallocHandler(trackedMalloc);
+            FbxSetCallocHandler(trackedCalloc);
+            FbxSetReallocHandler(trackedRealloc);
+            FbxSetFreeHandler(trackedFree);
+        });
+    }
+    
+    size_t current() {
+        return static_cast<size_t>(std::max(currentBytes.load(), 0LL));
+    }
+    
+    size_t peak() {
+        return static_cast<size_t>(std::max(peakBytes.load(), 0LL));
+    }
+    
+    void resetPeak() {
+        peakBytes.store(currentBytes.load());
+    }
+}
@@ -0,0 +1,25 @@
+//
+//  Memory.h
+//  FBXSceneFramework
+//
+//  Created by  Ivan Ushakov on 18/10/2026.
+//  Copyright © 2026  Ivan Ushakov. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+
+namespace memory
+{
+    // Route FBX SDK allocations through the counters. Must run before the first FbxManager is created.
+    void install();
+    
+    // Bytes currently held by the FBX SDK in the whole process.
+    size_t current();
+    
+    // Highest value of current() since the last reset.
+    size_t peak();
+    
+    void resetPeak();
+}
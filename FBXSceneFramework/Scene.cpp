@@ -8,62 +8,189 @@
 
 #include "Scene.h"
 
-Scene::Scene() : needDisplay_(false) {}
+#include <algorithm>
+
+#include "Memory.h"
+
+static simd_double4x4 toSimd(const FbxAMatrix &matrix) {
+    simd_double4x4 result;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            result.columns[i][j] = matrix.Get(i, j);
+        }
+    }
+    return result;
+}
+
+static simd_float4x4 toPosition(const simd_double4x4 &gp) {
+    return simd_float4x4{{
+        {static_cast<float>(gp.columns[0][0]), static_cast<float>(gp.columns[0][1]), static_cast<float>(gp.columns[0][2]), static_cast<float>(gp.columns[0][3])},
+        {static_cast<float>(gp.columns[1][0]), static_cast<float>(gp.columns[1][1]), static_cast<float>(gp.columns[1][2]), static_cast<float>(gp.columns[1][3])},
+        {static_cast<float>(gp.columns[2][0]), static_cast<float>(gp.columns[2][1]), static_cast<float>(gp.columns[2][2]), static_cast<float>(gp.columns[2][3])},
+        {static_cast<float>(gp.columns[3][0]), static_cast<float>(gp.columns[3][1]), static_cast<float>(gp.columns[3][2]), static_cast<float>(gp.columns[3][3])}
+    }};
+}
+
+static Ray toLocal(const Ray &ray, const simd_float4x4 &inverse) {
+    const simd_float4 origin = simd_mul(inverse, simd_float4 {ray.origin.x, ray.origin.y, ray.origin.z, 1.0f});
+    const simd_float4 direction = simd_mul(inverse, simd_float4 {ray.direction.x, ray.direction.y, ray.direction.z, 0.0f});
+    return Ray{origin.xyz, direction.xyz, ray.maxDistance};
+}
+
+template <typename T>
+static size_t bytes(const std::vector<T> &v) {
+    return v.capacity() * sizeof(T);
+}
+
+Scene::Scene() : frameCount_(0), currentFrame_(0), peakLoadMemory_(0), needDisplay_(false) {}
 
 void Scene::load(const std::string &path) {
-    FbxManager *manager = FbxManager::Create();
-    
-    FbxIOSettings *settings = FbxIOSettings::Create(manager, IOSROOT);
-    manager->SetIOSettings(settings);
-    
-    FbxImporter *importer = FbxImporter::Create(manager, "");
+    memory::install();
+    memory::resetPeak();
     
-    if (!importer->Initialize(path.c_str(), -1, manager->GetIOSettings())) {
-        throw std::runtime_error("");
-    }
+    FbxManager *manager = FbxManager::Create();
     
-    scene_ = FbxScene::Create(manager, "Scene");
-    if (!importer->Import(scene_)) {
-        throw std::runtime_error("");
+    try {
+        FbxIOSettings *settings = FbxIOSettings::Create(manager, IOSROOT);
+        manager->SetIOSettings(settings);
+        
+        FbxImporter *importer = FbxImporter::Create(manager, "");
+        
+        if (!importer->Initialize(path.c_str(), -1, manager->GetIOSettings())) {
+            throw std::runtime_error("");
+        }
+        
+        FbxScene *scene = FbxScene::Create(manager, "Scene");
+        if (!importer->Import(scene)) {
+            throw std::runtime_error("");
+        }
+        
+        importer->Destroy();
+        
+        // Convert Axis System to what is used in this example, if needed
+        FbxAxisSystem SceneAxisSystem = scene->GetGlobalSettings().GetAxisSystem();
+        FbxAxisSystem OurAxisSystem(FbxAxisSystem::eYAxis, FbxAxisSystem::eParityOdd, FbxAxisSystem::eRightHanded);
+        if (SceneAxisSystem != OurAxisSystem) {
+            OurAxisSystem.ConvertScene(scene);
+        }
+        
+        FbxGeometryConverter converter(manager);
+        converter.Triangulate(scene, true);
+        
+        FbxTime frameTime;
+        frameTime.SetTime(0, 0, 0, 1, 0, scene->GetGlobalSettings().GetTimeMode());
+        
+        FbxArray<FbxString *> animStackNameArray;
+        scene->FillAnimStackNameArray(animStackNameArray);
+        
+        // select the base layer from the animation stack
+        FbxAnimStack *currentAnimationStack = animStackNameArray.GetCount() > 0 ?
+        scene->FindMember<FbxAnimStack>(animStackNameArray[0]->Buffer()) : NULL;
+        FbxArrayDelete(animStackNameArray);
+        if (currentAnimationStack == NULL) {
+            throw std::runtime_error("");
+        }
+        
+        // we assume that the first animation layer connected to the animation stack is the base layer
+        // (this is the assumption made in the FBXSDK)
+        scene->SetCurrentAnimationStack(currentAnimationStack);
+        
+        // sample the frames the timer walks through
+        const FbxTime start = 0;
+        const FbxTime stop = start + frameTime;
+        
+        std::vector<FbxTime> times;
+        for (FbxTime time = start; time <= stop; time += frameTime) {
+            times.push_back(time);
+        }
+        
+        const size_t importPeak = memory::peak();
+        memory::resetPeak();
+        
+        bakeNodeRecursive(scene->GetRootNode(), times);
+        
+        const size_t bakePeak = memory::peak();
+        const MemoryUsage usage = memoryUsage();
+        peakLoadMemory_ = std::max(importPeak, bakePeak + usage.geometry + usage.animation + usage.skin);
+        
+        frameCount_ = times.size();
+        currentFrame_ = 0;
+    } catch (...) {
+        manager->Destroy();
+        throw;
     }
     
-    // Convert Axis System to what is used in this example, if needed
-    FbxAxisSystem SceneAxisSystem = scene_->GetGlobalSettings().GetAxisSystem();
-    FbxAxisSystem OurAxisSystem(FbxAxisSystem::eYAxis, FbxAxisSystem::eParityOdd, FbxAxisSystem::eRightHanded);
-    if (SceneAxisSystem != OurAxisSystem) {
-        OurAxisSystem.ConvertScene(scene_);
+    // nothing is read from the SDK after baking
+    manager->Destroy();
+}
+
+void Scene::allocateGeometry() {
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    for (auto &&m : mesh_) {
+        vertexCount += m->vertexCount;
+        indexCount += m->indexCount;
     }
     
-    FbxGeometryConverter converter(manager);
-    converter.Triangulate(scene_, true);
-    
-    loadCacheRecursive(scene_->GetRootNode());
-    
-    frameTime_.SetTime(0, 0, 0, 1, 0, scene_->GetGlobalSettings().GetTimeMode());
+    // Fresh arenas of the exact scene size, buffers sized from them carry no slack
+    // and a second call does not keep the blocks of the first one.
+    vertexArena_ = Arena(vertexCount);
+    indexArena_ = Arena(indexCount);
     
-    scene_->FillAnimStackNameArray(animStackNameArray_);
-    
-    // select the base layer from the animation stack
-    FbxAnimStack *currentAnimationStack = scene_->FindMember<FbxAnimStack>(animStackNameArray_[0]->Buffer());
-    if (currentAnimationStack == NULL) {
-        throw std::runtime_error("");
+    for (auto &&m : mesh_) {
+        m->baseVertex = m->vertexCount > 0 ? vertexArena_.allocate(m->vertexCount) : 0;
+        m->indexOffset = m->indexCount > 0 ? indexArena_.allocate(m->indexCount) : 0;
     }
+}
+
+void Scene::uploadGeometry() {
+    for (size_t i = 0; i < mesh_.size(); i++) {
+        SimpleMesh &m = *mesh_[i];
+        BakedMesh &b = bakedMesh_[i];
+        if (!b.drawable) {
+            continue;
+        }
+        
+        for (size_t j = 0; j < b.controlPoints.size(); j++) {
+            Vertex &v = m.vertexArray[j];
+            v.position = b.controlPoints[j];
+            v.uv = b.uvs[j];
+            v.normal = b.normals[j];
+        }
+        
+        std::copy(b.indices.begin(), b.indices.end(), m.indexArray);
+        
+        // From now on the tree reads the uploaded vertices and indices, so skinning refits it in place.
+        bvh_[i].setGeometry(&m.vertexArray[0].position, sizeof(Vertex), m.indexArray);
+        
+        // nothing reads them on the CPU after this point
+        std::vector<simd_float2>().swap(b.uvs);
+        std::vector<simd_float3>().swap(b.normals);
+        std::vector<uint32_t>().swap(b.indices);
+    }
+}
+
+void Scene::buildDrawList(const std::vector<uint32_t> &materials) {
+    std::vector<DrawItem> items;
+    items.reserve(mesh_.size());
     
-    // we assume that the first animation layer connected to the animation stack is the base layer
-    // (this is the assumption made in the FBXSDK)
-    scene_->SetCurrentAnimationStack(currentAnimationStack);
-    
-    start_ = 0;
-    stop_ = start_ + frameTime_;
-    
-    currentTime_ = start_;
+    for (size_t i = 0; i < mesh_.size(); i++) {
+        const auto &m = mesh_[i];
+        items.push_back(DrawItem{
+            static_cast<uint32_t>(i),
+            i < materials.size() ? materials[i] : DrawList::NoMaterial,
+            m->indexCount,
+            m->indexOffset,
+            m->baseVertex
+        });
+    }
     
-    importer->Destroy();
+    drawList_.build(items);
 }
 
 void Scene::onTimerClick() {
-    if (currentTime_ < stop_) {
-        currentTime_ += frameTime_;
+    if (currentFrame_ + 1 < frameCount_) {
+        currentFrame_++;
         needDisplay_ = true;
     } else {
         needDisplay_ = false;
@@ -75,57 +202,127 @@ void Scene::onDisplay() {
         return;
     }
     
-    FbxAMatrix dummyGlobalPosition;
-    drawNodeRecursive(scene_->GetRootNode(), currentTime_, dummyGlobalPosition);
+    for (size_t i = 0; i < mesh_.size(); i++) {
+        drawMesh(*mesh_[i], bakedMesh_[i], bvh_[i], currentFrame_);
+    }
 }
 
-void Scene::loadCacheRecursive(FbxNode *node) {
-    FbxNodeAttribute *nodeAttribute = node->GetNodeAttribute();
-    if (nodeAttribute) {
-        if (nodeAttribute->GetAttributeType() == FbxNodeAttribute::eMesh) {
-            FbxMesh *mesh = node->GetMesh();
-            mesh_.emplace_back(std::make_unique<SimpleMesh>());
-            
-            auto &m = mesh_.back();
-            m->vertexCount = mesh->GetControlPointsCount();
-            m->indexCount = 3 * mesh->GetPolygonCount();
-            m->name = std::string(node->GetName());
-            
-            mesh->SetUserDataPtr(m.get());
+MemoryUsage Scene::memoryUsage() const {
+    MemoryUsage usage = {};
+    
+    usage.geometry += mesh_.size() * sizeof(SimpleMesh);
+    
+    // The shared vertex and index buffers are sized from the arenas.
+    usage.geometry += vertexArena_.capacity() * sizeof(Vertex) + indexArena_.capacity() * sizeof(uint32_t);
+    
+    for (auto &&b : bakedMesh_) {
+        usage.geometry += sizeof(BakedMesh) + bytes(b.controlPoints) + bytes(b.uvs) + bytes(b.normals) + bytes(b.indices);
+        usage.animation += bytes(b.globalTransforms);
+        
+        for (auto &&cluster : b.skin.clusters) {
+            usage.skin += sizeof(BakedCluster) + bytes(cluster.indices) + bytes(cluster.weights);
+            usage.animation += bytes(cluster.transforms);
         }
     }
     
-    const int childCount = node->GetChildCount();
-    for (int childIndex = 0; childIndex < childCount; childIndex++) {
-        loadCacheRecursive(node->GetChild(childIndex));
+    for (auto &&bvh : bvh_) {
+        usage.geometry += sizeof(Bvh) + bvh.memorySize();
     }
+    
+    usage.transient = bytes(clusterDeformation_) + bytes(clusterWeight_) + bytes(vertexArray_) + memory::current();
+    usage.peakLoad = peakLoadMemory_;
+    
+    return usage;
 }
 
-void Scene::drawNodeRecursive(FbxNode *node, FbxTime &time, FbxAMatrix &parentGlobalPosition) {
-    FbxAMatrix globalPosition = node->EvaluateGlobalTransform(time);
-    if (node->GetNodeAttribute()) {
-        // Geometry offset. It is not inherited by the children.
-        FbxAMatrix geometryOffset = fbx::GetGeometry(node);
-        FbxAMatrix globalOffPosition = globalPosition * geometryOffset;
+bool Scene::intersect(const Ray &ray, RayHit &hit) const {
+    hit = RayHit{-1, Bvh::NoTriangle, simd_float2 {0.0f, 0.0f}, ray.maxDistance};
+    
+    for (size_t i = 0; i < mesh_.size(); i++) {
+        if (bvh_[i].triangleCount() == 0) {
+            continue;
+        }
         
-        drawNode(node, time, parentGlobalPosition, globalOffPosition);
+        // An affine transform keeps the distance along the ray, so hits of all meshes compare directly.
+        const Ray localRay = toLocal(ray, simd_inverse(mesh_[i]->position));
+        if (bvh_[i].intersect(localRay, hit)) {
+            hit.mesh = static_cast<int>(i);
+        }
     }
     
-    const int childCount = node->GetChildCount();
-    for (int childIndex = 0; childIndex < childCount; childIndex++) {
-        drawNodeRecursive(node->GetChild(childIndex), time, globalPosition);
+    return hit.mesh >= 0;
+}
+
+void Scene::intersect(const std::vector<Ray> &rays, std::vector<RayHit> &hits) const {
+    hits.resize(rays.size());
+    for (size_t j = 0; j < rays.size(); j++) {
+        hits[j] = RayHit{-1, Bvh::NoTriangle, simd_float2 {0.0f, 0.0f}, rays[j].maxDistance};
+    }
+    
+    std::vector<Ray> localRays(rays.size());
+    std::vector<RayHit> localHits(rays.size());
+    
+    for (size_t i = 0; i < mesh_.size(); i++) {
+        if (bvh_[i].triangleCount() == 0) {
+            continue;
+        }
+        
+        const simd_float4x4 inverse = simd_inverse(mesh_[i]->position);
+        for (size_t j = 0; j < rays.size(); j++) {
+            localRays[j] = toLocal(rays[j], inverse);
+            localHits[j] = RayHit{-1, Bvh::NoTriangle, simd_float2 {0.0f, 0.0f}, hits[j].distance};
+        }
+        
+        bvh_[i].intersect(localRays.data(), localHits.data(), localRays.size());
+        
+        for (size_t j = 0; j < rays.size(); j++) {
+            if (localHits[j].triangle != Bvh::NoTriangle) {
+                hits[j] = localHits[j];
+                hits[j].mesh = static_cast<int>(i);
+            }
+        }
     }
 }
 
-void Scene::drawNode(FbxNode *node, FbxTime &time, FbxAMatrix &parentGlobalPosition, FbxAMatrix &globalPosition) {
-    const FbxNodeAttribute *nodeAttribute = node->GetNodeAttribute();
-    if (nodeAttribute->GetAttributeType() == FbxNodeAttribute::eMesh) {
-        drawMesh(node, time, globalPosition);
+void Scene::bakeNodeRecursive(FbxNode *node, const std::vector<FbxTime> &times) {
+    FbxNodeAttribute *nodeAttribute = node->GetNodeAttribute();
+    if (nodeAttribute) {
+        if (nodeAttribute->GetAttributeType() == FbxNodeAttribute::eMesh) {
+            bakeMesh(node, times);
+        }
+    }
+    
+    const int childCount = node->GetChildCount();
+    for (int childIndex = 0; childIndex < childCount; childIndex++) {
+        bakeNodeRecursive(node->GetChild(childIndex), times);
     }
 }
 
-void Scene::drawMesh(FbxNode *node, FbxTime &time, FbxAMatrix &globalPosition) {
+void Scene::bakeMesh(FbxNode *node, const std::vector<FbxTime> &times) {
     FbxMesh *mesh = node->GetMesh();
+    mesh_.emplace_back(std::make_unique<SimpleMesh>());
+    
+    auto &m = mesh_.back();
+    m->vertexCount = mesh->GetControlPointsCount();
+    m->indexCount = 3 * mesh->GetPolygonCount();
+    m->name = std::string(node->GetName());
+    
+    bakedMesh_.emplace_back();
+    bvh_.emplace_back();
+    
+    BakedMesh &b = bakedMesh_.back();
+    b.drawable = false;
+    b.skin.linkMode = BakedSkin::Normalize;
+    
+    // Geometry offset. It is not inherited by the children.
+    const simd_double4x4 geometryOffset = toSimd(fbx::GetGeometry(node));
+    b.globalTransforms.reserve(times.size());
+    for (auto &&time : times) {
+        b.globalTransforms.push_back(simd_mul(toSimd(node->EvaluateGlobalTransform(time)), geometryOffset));
+    }
+    
+    m->position = toPosition(b.globalTransforms[0]);
+    
     const int vertexCount = mesh->GetControlPointsCount();
     
     // No vertex to draw.
@@ -149,87 +346,177 @@ void Scene::drawMesh(FbxNode *node, FbxTime &time, FbxAMatrix &globalPosition) {
         return;
     }
     
-    // If it has some defomer connection, update the vertices position
+    // Only skin deformers are supported
     const bool hasVertexCache = mesh->GetDeformerCount(FbxDeformer::eVertexCache) &&
     (static_cast<FbxVertexCacheDeformer *>(mesh->GetDeformer(0, FbxDeformer::eVertexCache)))->Active.Get();
     const bool hasShape = mesh->GetShapeCount() > 0;
-    const bool hasSkin = mesh->GetDeformerCount(FbxDeformer::eSkin) > 0;
-    const bool hasDeformation = hasVertexCache || hasShape || hasSkin;
+    if (hasVertexCache || hasShape) {
+        throw std::runtime_error("");
+    }
     
-    std::vector<FbxVector4> vertexArray(vertexCount);
-    memcpy(vertexArray.data(), mesh->GetControlPoints(), vertexCount * sizeof(FbxVector4));
+    b.drawable = true;
     
-    if (hasDeformation) {
-        // Active vertex cache deformer will overwrite any other deformer
-        if (hasVertexCache) {
-            throw std::runtime_error("");
-        } else {
-            if (hasShape) {
-                throw std::runtime_error("");
-            }
-            
-            // we need to get the number of clusters
-            const int skinCount = mesh->GetDeformerCount(FbxDeformer::eSkin);
-            int clusterCount = 0;
-            for (int skinIndex = 0; skinIndex < skinCount; skinIndex++) {
-                clusterCount += ((FbxSkin *)(mesh->GetDeformer(skinIndex, FbxDeformer::eSkin)))->GetClusterCount();
-            }
-            if (clusterCount) {
-                // Deform the vertex array with the skin deformer.
-                fbx::ComputeSkinDeformation(globalPosition, mesh, time, vertexArray.data());
-            }
-        }
+    const FbxVector4 *controlPoints = mesh->GetControlPoints();
+    b.controlPoints.resize(vertexCount);
+    for (int i = 0; i < vertexCount; i++) {
+        const FbxVector4 &p = controlPoints[i];
+        b.controlPoints[i] = simd::float3 {
+            static_cast<float>(p[0]),
+            static_cast<float>(p[1]),
+            static_cast<float>(p[2])
+        };
     }
     
-    SimpleMesh *m = static_cast<SimpleMesh *>(mesh->GetUserDataPtr());
-    
-    const auto& gp = globalPosition;
-    m->position = simd_float4x4{{
-        {static_cast<float>(gp.Get(0, 0)), static_cast<float>(gp.Get(0, 1)), static_cast<float>(gp.Get(0, 2)), static_cast<float>(gp.Get(0, 3))},
-        {static_cast<float>(gp.Get(1, 0)), static_cast<float>(gp.Get(1, 1)), static_cast<float>(gp.Get(1, 2)), static_cast<float>(gp.Get(1, 3))},
-        {static_cast<float>(gp.Get(2, 0)), static_cast<float>(gp.Get(2, 1)), static_cast<float>(gp.Get(2, 2)), static_cast<float>(gp.Get(2, 3))},
-        {static_cast<float>(gp.Get(3, 0)), static_cast<float>(gp.Get(3, 1)), static_cast<float>(gp.Get(3, 3)), static_cast<float>(gp.Get(3, 3))}
-    }};
+    b.uvs.resize(vertexCount);
+    b.normals.resize(vertexCount);
+    b.indices.reserve(m->indexCount);
     
     const int polygonCount = mesh->GetPolygonCount();
-    size_t indexArrayPosition = 0;
     for (int polygonIndex = 0; polygonIndex < polygonCount; polygonIndex++) {
         for (int verticeIndex = 0; verticeIndex < 3; verticeIndex++) {
             const int controlPointIndex = mesh->GetPolygonVertex(polygonIndex, verticeIndex);
-            Vertex &v = m->vertexArray[controlPointIndex];
-            
-            const FbxVector4 &p = vertexArray[controlPointIndex];
-            v.position = simd::float3 {
-                static_cast<float>(p[0]),
-                static_cast<float>(p[1]),
-                static_cast<float>(p[2])
-            };
-            
-            m->maxBounds.x = std::max(m->maxBounds.x, v.position.x);
-            m->maxBounds.y = std::max(m->maxBounds.y, v.position.y);
-            m->maxBounds.z = std::max(m->maxBounds.z, v.position.z);
-            
-            m->minBounds.x = std::min(m->minBounds.x, v.position.x);
-            m->minBounds.y = std::min(m->minBounds.y, v.position.y);
-            m->minBounds.z = std::min(m->minBounds.z, v.position.z);
             
             FbxVector2 uv;
             bool unmapped = false;
             mesh->GetPolygonVertexUV(polygonIndex, verticeIndex, "UVChannel_1", uv, unmapped);
-            v.uv = simd::float2 {
+            b.uvs[controlPointIndex] = simd::float2 {
                 static_cast<float>(uv[0]),
                 static_cast<float>(uv[1])
             };
             
             FbxVector4 normal;
             mesh->GetPolygonVertexNormal(polygonIndex, verticeIndex, normal);
-            v.normal = simd::float3 {
+            b.normals[controlPointIndex] = simd::float3 {
                 static_cast<float>(normal[0]),
                 static_cast<float>(normal[1]),
                 static_cast<float>(normal[2])
             };
             
-            m->indexArray[indexArrayPosition++] = mesh->GetPolygonVertex(polygonIndex, verticeIndex);
+            b.indices.push_back(static_cast<uint32_t>(controlPointIndex));
+        }
+    }
+    
+    bvh_.back().build(b.controlPoints.data(), sizeof(simd_float3), b.indices.data(), b.indices.size());
+    
+    if (mesh->GetDeformerCount(FbxDeformer::eSkin) > 0) {
+        bakeSkin(node, b, times);
+    }
+}
+
+void Scene::bakeSkin(FbxNode *node, BakedMesh &b, const std::vector<FbxTime> &times) {
+    FbxMesh *mesh = node->GetMesh();
+    
+    FbxSkin *firstSkin = (FbxSkin *)mesh->GetDeformer(0, FbxDeformer::eSkin);
+    FbxSkin::EType skinningType = firstSkin->GetSkinningType();
+    if (skinningType != FbxSkin::eLinear && skinningType != FbxSkin::eRigid) {
+        return;
+    }
+    
+    if (firstSkin->GetClusterCount() == 0) {
+        return;
+    }
+    
+    // All the links must have the same link mode.
+    switch (firstSkin->GetCluster(0)->GetLinkMode()) {
+        case FbxCluster::eNormalize:
+            b.skin.linkMode = BakedSkin::Normalize;
+            break;
+        case FbxCluster::eAdditive:
+            b.skin.linkMode = BakedSkin::Additive;
+            break;
+        case FbxCluster::eTotalOne:
+            b.skin.linkMode = BakedSkin::TotalOne;
+            break;
+    }
+    
+    std::vector<FbxAMatrix> globalPositions;
+    for (auto &&time : times) {
+        globalPositions.push_back(node->EvaluateGlobalTransform(time) * fbx::GetGeometry(node));
+    }
+    
+    const int vertexCount = mesh->GetControlPointsCount();
+    
+    const int skinCount = mesh->GetDeformerCount(FbxDeformer::eSkin);
+    for (int skinIndex = 0; skinIndex < skinCount; skinIndex++) {
+        FbxSkin *skinDeformer = (FbxSkin *)mesh->GetDeformer(skinIndex, FbxDeformer::eSkin);
+        const int clusterCount = skinDeformer->GetClusterCount();
+        for (int clusterIndex = 0; clusterIndex < clusterCount; clusterIndex++) {
+            FbxCluster *cluster = skinDeformer->GetCluster(clusterIndex);
+            if (!cluster->GetLink()) {
+                continue;
+            }
+            
+            BakedCluster bakedCluster;
+            
+            const int vertexIndexCount = cluster->GetControlPointIndicesCount();
+            for (int k = 0; k < vertexIndexCount; k++) {
+                const int index = cluster->GetControlPointIndices()[k];
+                
+                // Sometimes, the mesh can have less points than at the time of the skinning
+                // because a smooth operator was active when skinning but has been deactivated during export.
+                if (index >= vertexCount) {
+                    continue;
+                }
+                
+                const double weight = cluster->GetControlPointWeights()[k];
+                if (weight == 0.0) {
+                    continue;
+                }
+                
+                bakedCluster.indices.push_back(static_cast<uint32_t>(index));
+                bakedCluster.weights.push_back(weight);
+            }
+            
+            bakedCluster.transforms.reserve(times.size());
+            for (size_t frame = 0; frame < times.size(); frame++) {
+                FbxAMatrix vertexTransformMatrix;
+                fbx::ComputeClusterDeformation(globalPositions[frame], mesh, cluster, vertexTransformMatrix, times[frame]);
+                bakedCluster.transforms.push_back(toSimd(vertexTransformMatrix));
+            }
+            
+            bakedCluster.indices.shrink_to_fit();
+            bakedCluster.weights.shrink_to_fit();
+            b.skin.clusters.push_back(std::move(bakedCluster));
         }
     }
 }
+
+void Scene::drawMesh(SimpleMesh &m, const BakedMesh &b, Bvh &bvh, size_t frame) {
+    if (!b.drawable) {
+        return;
+    }
+    
+    const size_t vertexCount = b.controlPoints.size();
+    
+    vertexArray_.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++) {
+        const simd_float3 &p = b.controlPoints[i];
+        vertexArray_[i] = simd_double3 {p.x, p.y, p.z};
+    }
+    
+    if (!b.skin.clusters.empty()) {
+        // Deform the vertex array with the skin deformer.
+        computeSkinDeformation(b.skin, frame, vertexArray_, clusterDeformation_, clusterWeight_);
+    }
+    
+    m.position = toPosition(b.globalTransforms[frame]);
+    
+    for (size_t i = 0; i < vertexCount; i++) {
+        Vertex &v = m.vertexArray[i];
+        
+        const simd_double3 &p = vertexArray_[i];
+        v.position = simd::float3 {
+            static_cast<float>(p.x),
+            static_cast<float>(p.y),
+            static_cast<float>(p.z)
+        };
+        
+        m.maxBounds = simd_max(m.maxBounds, v.position);
+        m.minBounds = simd_min(m.minBounds, v.position);
+    }
+    
+    // The topology never changes, only the bounds follow the skinned vertices.
+    if (!b.skin.clusters.empty()) {
+        bvh.refit();
+    }
+}
@@ -17,50 +17,106 @@
 
 #include <fbxsdk.h>
 
+#include "Arena.h"
+#include "Bvh.h"
 #include "Deformation.h"
+#include "DrawList.h"
+#include "Skinning.h"
 
 struct SimpleMesh {
     Vertex *vertexArray;
     size_t vertexCount;
     uint32_t *indexArray;
     size_t indexCount;
+    size_t baseVertex;
+    size_t indexOffset;
     std::string name;
     simd_float4x4 position;
     simd_float3 maxBounds;
     simd_float3 minBounds;
 };
 
+// Everything the per-frame update needs from an FbxMesh.
+struct BakedMesh {
+    bool drawable;
+    // Global transform of the mesh node with its geometry offset, one per animation frame.
+    std::vector<simd_double4x4> globalTransforms;
+    std::vector<simd_float3> controlPoints;
+    // Only kept until uploadGeometry.
+    std::vector<simd_float2> uvs;
+    std::vector<simd_float3> normals;
+    std::vector<uint32_t> indices;
+    BakedSkin skin;
+};
+
+struct MemoryUsage {
+    size_t geometry;
+    size_t animation;
+    size_t skin;
+    size_t transient;
+    size_t peakLoad;
+};
+
 class Scene {
 public:
     std::vector<std::unique_ptr<SimpleMesh>> mesh_;
     
+    Arena vertexArena_;
+    
+    Arena indexArena_;
+    
+    DrawList drawList_;
+    
     Scene();
     
+    // Imports the file, bakes it into engine structures and releases the FBX SDK objects.
     void load(const std::string &);
     
     void prepareIndexBuffers();
     
+    // Places every mesh into the shared vertex and index arenas, previous placement is discarded.
+    void allocateGeometry();
+    
+    // Writes the static part of the geometry and frees its CPU copy, must be called once the vertex and index arrays are set.
+    void uploadGeometry();
+    
+    // Takes a material id per mesh, DrawList::NoMaterial skips the mesh.
+    void buildDrawList(const std::vector<uint32_t> &);
+    
     void onTimerClick();
     
     void onDisplay();
+    
+    MemoryUsage memoryUsage() const;
+    
+    // Nearest hit over all meshes for a ray in world space, uses the geometry of the last onDisplay.
+    bool intersect(const Ray &, RayHit &) const;
+    
+    void intersect(const std::vector<Ray> &, std::vector<RayHit> &) const;
 
 private:
-    void loadCacheRecursive(FbxNode *);
+    void bakeNodeRecursive(FbxNode *, const std::vector<FbxTime> &);
+    
+    void bakeMesh(FbxNode *, const std::vector<FbxTime> &);
+    
+    void bakeSkin(FbxNode *, BakedMesh &, const std::vector<FbxTime> &);
     
-    void drawNodeRecursive(FbxNode *, FbxTime &, FbxAMatrix &);
+    void drawMesh(SimpleMesh &, const BakedMesh &, Bvh &, size_t);
     
-    void drawNode(FbxNode *, FbxTime &, FbxAMatrix &, FbxAMatrix &);
+    std::vector<BakedMesh> bakedMesh_;
     
-    void drawMesh(FbxNode *, FbxTime &, FbxAMatrix &);
+    // One per mesh, refitted after every skinning pass of a skinned mesh.
+    std::vector<Bvh> bvh_;
     
-    FbxScene *scene_;
+    // Scratch buffers reused by the skinning every frame.
+    std::vector<simd_double4x4> clusterDeformation_;
+    std::vector<double> clusterWeight_;
+    std::vector<simd_double3> vertexArray_;
     
-    FbxArray<FbxString *> animStackNameArray_;
+    size_t frameCount_;
+    size_t currentFrame_;
     
-    FbxTime frameTime_;
-    FbxTime start_;
-    FbxTime stop_;
-    FbxTime currentTime_;
+    size_t peakLoadMemory_;
     
     bool needDisplay_;
 };
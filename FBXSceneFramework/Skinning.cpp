@@ -0,0 +1,70 @@
+//
+//  Skinning.cpp
+//  FBXSceneFramework
+//
+//  Created by  Ivan Ushakov on 18/10/2026.
+//  Copyright © 2026  Ivan Ushakov. All rights reserved.
+//
+
+#include "Skinning.h"
+
+// Deform the vertex array in classic linear way.
+void computeSkinDeformation(const BakedSkin &skin,
+                            size_t frame,
+                            std::vector<simd_double3> &vertexArray,
+                            std::vector<simd_double4x4> &clusterDeformation,
+                            std::vector<double> &clusterWeight) {
+    const size_t vertexCount = vertexArray.size();
+    
+    const simd_double4x4 zero = {};
+    clusterDeformation.assign(vertexCount, skin.linkMode == BakedSkin::Additive ? matrix_identity_double4x4 : zero);
+    clusterWeight.assign(vertexCount, 0.0);
+    
+    // For all clusters, accumulate their deformation and weight
+    // on each vertices and store them in clusterDeformation and clusterWeight.
+    for (auto &&cluster : skin.clusters) {
+        const simd_double4x4 &vertexTransformMatrix = cluster.transforms[frame];
+        
+        for (size_t k = 0; k < cluster.indices.size(); k++) {
+            const uint32_t index = cluster.indices[k];
+            const double weight = cluster.weights[k];
+            
+            // Compute the influence of the link on the vertex.
+            simd_double4x4 influence = simd_mul(weight, vertexTransformMatrix);
+            
+            if (skin.linkMode == BakedSkin::Additive) {
+                // Multiply with the product of the deformations on the vertex.
+                influence = simd_add(influence, simd_diagonal_matrix(simd_double4 {1.0 - weight, 1.0 - weight, 1.0 - weight, 1.0 - weight}));
+                clusterDeformation[index] = simd_mul(influence, clusterDeformation[index]);
+                
+                // Set the link to 1.0 just to know this vertex is influenced by a link.
+                clusterWeight[index] = 1.0;
+            } else {
+                // Add to the sum of the deformations on the vertex.
+                clusterDeformation[index] = simd_add(clusterDeformation[index], influence);
+                
+                // Add to the sum of weights to either normalize or complete the vertex.
+                clusterWeight[index] += weight;
+            }
+        }
+    }
+    
+    // Actually deform each vertices here by information stored in clusterDeformation and clusterWeight
+    for (size_t i = 0; i < vertexCount; i++) {
+        const double weight = clusterWeight[i];
+        
+        // Deform the vertex if there was at least a link with an influence on the vertex,
+        if (weight != 0.0) {
+            const simd_double3 &srcVertex = vertexArray[i];
+            simd_double4 dstVertex = simd_mul(clusterDeformation[i], simd_double4 {srcVertex.x, srcVertex.y, srcVertex.z, 1.0});
+            if (skin.linkMode == BakedSkin::Normalize) {
+                // In the normalized link mode, a vertex is always totally influenced by the links.
+                dstVertex /= weight;
+            } else if (skin.linkMode == BakedSkin::TotalOne) {
+                // In the total 1 link mode, a vertex can be partially influenced by the links.
+                dstVertex += simd_double4 {srcVertex.x, srcVertex.y, srcVertex.z, 1.0} * (1.0 - weight);
+            }
+            vertexArray[i] = dstVertex.xyz;
+        }
+    }
+}
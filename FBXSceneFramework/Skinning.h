@@ -0,0 +1,37 @@
+//
+//  Skinning.h
+//  FBXSceneFramework
+//
+//  Created by  Ivan Ushakov on 18/10/2026.
+//  Copyright © 2026  Ivan Ushakov. All rights reserved.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <simd/simd.h>
+
+struct BakedCluster {
+    std::vector<uint32_t> indices;
+    std::vector<double> weights;
+    // Vertex transform of the cluster at every animation frame.
+    std::vector<simd_double4x4> transforms;
+};
+
+// Linear skin of a mesh, clusters of all its skin deformers are merged.
+struct BakedSkin {
+    enum LinkMode {
+        Normalize,
+        Additive,
+        TotalOne
+    };
+    
+    LinkMode linkMode;
+    std::vector<BakedCluster> clusters;
+};
+
+// Deform the vertex array in classic linear way. The last two arrays are scratch space reused between calls.
+void computeSkinDeformation(const BakedSkin &, size_t, std::vector<simd_double3> &, std::vector<simd_double4x4> &, std::vector<double> &);
@@ -1,37 +0,0 @@
-//
-//  FBXSceneFrameworkTests.m
-//  FBXSceneFrameworkTests
-//
-//  Created by  Ivan Ushakov on 18/04/2019.
-//  Copyright © 2019  Ivan Ushakov. All rights reserved.
-//
-
-#import <XCTest/XCTest.h>
-
-@interface FBXSceneFrameworkTests : XCTestCase
-
-@end
-
-@implementation FBXSceneFrameworkTests
-
-- (void)setUp {
-    // Put setup code here. This method is called before the invocation of each test method in the class.
-}
-
-- (void)tearDown {
-    // Put teardown code here. This method is called after the invocation of each test method in the class.
-}
-
-- (void)testExample {
-    // This is an example of a functional test case.
-    // Use XCTAssert and related functions to verify your tests produce the correct results.
-}
-
-- (void)testPerformanceExample {
-    // This is an example of a performance test case.
-    [self measureBlock:^{
-        // Put the code you want to measure the time of here.
-    }];
-}
-
-@end
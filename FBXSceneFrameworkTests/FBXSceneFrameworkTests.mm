@@ -0,0 +1,278 @@
+//
+//  FBXSceneFrameworkTests.mm
+//  FBXSceneFrameworkTests
+//
+//  Created by  Ivan Ushakov on 18/04/2019.
+//  Copyright © 2019  Ivan Ushakov. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#include <cfloat>
+#include <cmath>
+
+#include "Arena.h"
+#include "Bvh.h"
+#include "DrawList.h"
+#include "Skinning.h"
+
+// Wavy grid of size x size quads in the xy plane, two triangles per quad.
+static void makeGrid(uint32_t size, std::vector<simd_float3> &positions, std::vector<uint32_t> &indices) {
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            positions.push_back(simd_float3 {float(x), float(y), std::sin(0.1f * x) * std::cos(0.1f * y)});
+        }
+    }
+    
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            const uint32_t a = y * (size + 1) + x;
+            const uint32_t c = a + size + 1;
+            indices.insert(indices.end(), {a, a + 1, c + 1, a, c + 1, c});
+        }
+    }
+}
+
+// Rays pointing down at the grid from z = 10.
+static std::vector<Ray> makeRays(uint32_t size, size_t count) {
+    std::vector<Ray> rays(count);
+    for (size_t i = 0; i < count; i++) {
+        const float x = (i * 7919 % 1000) * size / 1000.0f;
+        const float y = (i * 104729 % 1000) * size / 1000.0f;
+        rays[i] = Ray{simd_float3 {x, y, 10.0f}, simd_float3 {0.05f, -0.03f, -1.0f}, FLT_MAX};
+    }
+    return rays;
+}
+
+static RayHit makeMiss(const Ray &ray) {
+    return RayHit{-1, Bvh::NoTriangle, simd_float2 {0.0f, 0.0f}, ray.maxDistance};
+}
+
+// Vertex 0 is moved by a translation and a scale cluster with a quarter of weight each, vertex 1 has no links.
+static BakedSkin makeSkin(BakedSkin::LinkMode linkMode) {
+    simd_double4x4 translation = matrix_identity_double4x4;
+    translation.columns[3] = simd_double4 {2.0, 0.0, 0.0, 1.0};
+    const simd_double4x4 scale = simd_diagonal_matrix(simd_double4 {3.0, 3.0, 3.0, 1.0});
+    
+    BakedSkin skin;
+    skin.linkMode = linkMode;
+    skin.clusters.push_back(BakedCluster{{0}, {0.25}, {translation}});
+    skin.clusters.push_back(BakedCluster{{0}, {0.25}, {scale}});
+    return skin;
+}
+
+// Skins vertex (1, 1, 0) and an unlinked vertex (0, 1, 0).
+static std::vector<simd_double3> skinVertices(BakedSkin::LinkMode linkMode) {
+    std::vector<simd_double3> vertexArray = {simd_double3 {1.0, 1.0, 0.0}, simd_double3 {0.0, 1.0, 0.0}};
+    std::vector<simd_double4x4> clusterDeformation;
+    std::vector<double> clusterWeight;
+    computeSkinDeformation(makeSkin(linkMode), 0, vertexArray, clusterDeformation, clusterWeight);
+    return vertexArray;
+}
+
+@interface FBXSceneFrameworkTests : XCTestCase
+
+@end
+
+@implementation FBXSceneFrameworkTests
+
+- (void)setUp {
+    // Put setup code here. This method is called before the invocation of each test method in the class.
+}
+
+- (void)tearDown {
+    // Put teardown code here. This method is called after the invocation of each test method in the class.
+}
+
+- (void)testArenaGrowth {
+    Arena arena(8);
+    
+    XCTAssertEqual(arena.allocate(4), 0u);
+    XCTAssertEqual(arena.allocate(4), 4u);
+    XCTAssertEqual(arena.allocate(4), 8u);
+    XCTAssertEqual(arena.capacity(), 16u);
+    XCTAssertEqual(arena.used(), 12u);
+}
+
+- (void)testArenaDefragment {
+    Arena arena(16);
+    
+    const size_t a = arena.allocate(4);
+    const size_t b = arena.allocate(4);
+    arena.allocate(4);
+    
+    arena.release(a);
+    arena.release(b);
+    
+    // Released neighbours are merged into one block.
+    XCTAssertEqual(arena.allocate(6), 0u);
+    
+    std::vector<Arena::Move> moves = arena.defragment();
+    XCTAssertEqual(moves.size(), 1u);
+    XCTAssertEqual(moves[0].from, 8u);
+    XCTAssertEqual(moves[0].to, 6u);
+    XCTAssertEqual(moves[0].count, 4u);
+    
+    XCTAssertEqual(arena.allocate(6), 10u);
+    XCTAssertEqual(arena.capacity(), 16u);
+}
+
+- (void)testDrawListSortedByMaterial {
+    DrawList list;
+    list.build({
+        DrawItem{0, 1, 3, 0, 0},
+        DrawItem{1, 0, 3, 3, 4},
+        DrawItem{2, DrawList::NoMaterial, 3, 6, 8},
+        DrawItem{3, 1, 3, 9, 12},
+        DrawItem{4, 0, 0, 12, 16}
+    });
+    
+    XCTAssertEqual(list.drawCount(), 3u);
+    XCTAssertEqual(list.materialBindCount(), 2u);
+    
+    XCTAssertEqual(list.items()[0].mesh, 1u);
+    XCTAssertEqual(list.items()[1].mesh, 0u);
+    XCTAssertEqual(list.items()[2].mesh, 3u);
+}
+
+- (void)testSkinLinkModes {
+    const simd_double3 rest = simd_double3 {0.0, 1.0, 0.0};
+    
+    // Weighted average of the two transformed positions (3, 1, 0) and (3, 3, 0).
+    std::vector<simd_double3> normalized = skinVertices(BakedSkin::Normalize);
+    XCTAssertLessThan(simd_distance(normalized[0], simd_double3 {3.0, 2.0, 0.0}), 1e-9);
+    XCTAssertLessThan(simd_distance(normalized[1], rest), 1e-9);
+    
+    // The remaining half of the weight keeps the rest position.
+    std::vector<simd_double3> totalOne = skinVertices(BakedSkin::TotalOne);
+    XCTAssertLessThan(simd_distance(totalOne[0], simd_double3 {2.0, 1.5, 0.0}), 1e-9);
+    XCTAssertLessThan(simd_distance(totalOne[1], rest), 1e-9);
+    
+    // Translation by 0.5 and then scale by 1.5.
+    std::vector<simd_double3> additive = skinVertices(BakedSkin::Additive);
+    XCTAssertLessThan(simd_distance(additive[0], simd_double3 {2.25, 1.5, 0.0}), 1e-9);
+    XCTAssertLessThan(simd_distance(additive[1], rest), 1e-9);
+}
+
+- (void)testBvhHit {
+    std::vector<simd_float3> positions;
+    std::vector<uint32_t> indices;
+    makeGrid(4, positions, indices);
+    
+    Bvh bvh;
+    bvh.build(positions.data(), sizeof(simd_float3), indices.data(), indices.size());
+    XCTAssertEqual(bvh.triangleCount(), 32u);
+    
+    // Straight down into the quad at (1, 2), first triangle of the quad is (a, a + 1, c + 1).
+    const Ray ray = Ray{simd_float3 {1.75f, 2.25f, 10.0f}, simd_float3 {0.0f, 0.0f, -1.0f}, FLT_MAX};
+    RayHit hit = makeMiss(ray);
+    XCTAssertTrue(bvh.intersect(ray, hit));
+    XCTAssertEqual(hit.triangle, 2u * (2 * 4 + 1));
+    XCTAssertEqualWithAccuracy(hit.barycentrics.x, 0.5f, 1e-4f);
+    XCTAssertEqualWithAccuracy(hit.barycentrics.y, 0.25f, 1e-4f);
+    
+    const Ray away = Ray{ray.origin, simd_float3 {0.0f, 0.0f, 1.0f}, FLT_MAX};
+    RayHit miss = makeMiss(away);
+    XCTAssertFalse(bvh.intersect(away, miss));
+}
+
+- (void)testBvhPacketsMatchSingleRays {
+    std::vector<simd_float3> positions;
+    std::vector<uint32_t> indices;
+    makeGrid(64, positions, indices);
+    
+    Bvh bvh;
+    bvh.build(positions.data(), sizeof(simd_float3), indices.data(), indices.size());
+    
+    const std::vector<Ray> rays = makeRays(64, 1001);
+    std::vector<RayHit> hits;
+    for (auto &&ray : rays) {
+        hits.push_back(makeMiss(ray));
+    }
+    bvh.intersect(rays.data(), hits.data(), rays.size());
+    
+    for (size_t i = 0; i < rays.size(); i++) {
+        RayHit hit = makeMiss(rays[i]);
+        bvh.intersect(rays[i], hit);
+        XCTAssertEqual(hits[i].triangle, hit.triangle);
+        XCTAssertEqualWithAccuracy(hits[i].distance, hit.distance, 1e-4f);
+    }
+}
+
+- (void)testBvhRefit {
+    std::vector<simd_float3> positions;
+    std::vector<uint32_t> indices;
+    makeGrid(16, positions, indices);
+    
+    Bvh bvh;
+    bvh.build(positions.data(), sizeof(simd_float3), indices.data(), indices.size());
+    
+    for (auto &&p : positions) {
+        p.z -= 5.0f;
+    }
+    bvh.refit();
+    
+    const Ray ray = Ray{simd_float3 {8.5f, 8.5f, 10.0f}, simd_float3 {0.0f, 0.0f, -1.0f}, FLT_MAX};
+    RayHit hit = makeMiss(ray);
+    XCTAssertTrue(bvh.intersect(ray, hit));
+    XCTAssertEqualWithAccuracy(hit.distance, 15.0f - std::sin(0.85f) * std::cos(0.85f), 0.05f);
+    XCTAssertLessThan(bvh.nodes()[0].maxBounds[2], -3.9f);
+}
+
+- (void)testBvhBuildPerformance {
+    std::vector<simd_float3> positions;
+    std::vector<uint32_t> indices;
+    makeGrid(256, positions, indices);
+    
+    [self measureBlock:^{
+        Bvh bvh;
+        bvh.build(positions.data(), sizeof(simd_float3), indices.data(), indices.size());
+    }];
+}
+
+- (void)testBvhRefitPerformance {
+    std::vector<simd_float3> positions;
+    std::vector<uint32_t> indices;
+    makeGrid(256, positions, indices);
+    
+    __block Bvh bvh;
+    bvh.build(positions.data(), sizeof(simd_float3), indices.data(), indices.size());
+    
+    [self measureBlock:^{
+        bvh.refit();
+    }];
+}
+
+// 65536 rays per iteration, rays per second is that divided by the measured time.
+- (void)testBvhRayPerformance {
+    std::vector<simd_float3> positions;
+    std::vector<uint32_t> indices;
+    makeGrid(256, positions, indices);
+    
+    Bvh bvh;
+    bvh.build(positions.data(), sizeof(simd_float3), indices.data(), indices.size());
+    
+    const std::vector<Ray> rays = makeRays(256, 65536);
+    __block std::vector<RayHit> hits(rays.size());
+    
+    [self measureBlock:^{
+        for (size_t i = 0; i < rays.size(); i++) {
+            hits[i] = makeMiss(rays[i]);
+        }
+        bvh.intersect(rays.data(), hits.data(), rays.size());
+    }];
+}
+
+- (void)testDrawListPerformance {
+    std::vector<DrawItem> items;
+    for (uint32_t i = 0; i < 10000; i++) {
+        items.push_back(DrawItem{i, i % 16, 3, 3 * i, 4 * i});
+    }
+    
+    [self measureBlock:^{
+        DrawList list;
+        list.build(items);
+    }];
+}
+
+@end
@@ -31,10 +31,14 @@ typedef struct
 } InputVertex;
 
 vertex VertexShaderOutput vertex_shader(InputVertex v [[stage_in]],
-                                        constant Uniforms &uniforms [[buffer(1)]])
+                                        constant Uniforms *uniform_array [[buffer(1)]],
+                                        uint instance [[instance_id]])
 {
     VertexShaderOutput output;
     
+    // base instance of the draw selects its entry in the packed uniforms
+    constant Uniforms &uniforms = uniform_array[instance];
+    
     float4 world_position = uniforms.model_matrix * float4(v.position, 1.0);
     output.position = uniforms.projection_matrix * uniforms.view_matrix * world_position;
     
@@ -13,23 +13,27 @@ enum MaterialError: Error {
 }
 
 protocol Material {
-    func setTextures(encoder: MTLRenderCommandEncoder)
+    // Returns the number of textures bound.
+    @discardableResult
+    func setTextures(encoder: MTLRenderCommandEncoder) -> Int
 }
 
 class PBRMaterial: Material {
     
+    private static let slots: [PBRTextureType] = [.baseColor, .metallic, .roughness, .ambientOcclusion, .normal]
+    
     private let textures: [PBRTextureType : MTLTexture]
     
     fileprivate init(textures: [PBRTextureType : MTLTexture]) throws {
         self.textures = textures
     }
     
-    func setTextures(encoder: MTLRenderCommandEncoder) {
-        encoder.setFragmentTexture(textures[.baseColor], index: 0)
-        encoder.setFragmentTexture(textures[.metallic], index: 1)
-        encoder.setFragmentTexture(textures[.roughness], index: 2)
-        encoder.setFragmentTexture(textures[.ambientOcclusion], index: 3)
-        encoder.setFragmentTexture(textures[.normal], index: 4)
+    @discardableResult
+    func setTextures(encoder: MTLRenderCommandEncoder) -> Int {
+        for (index, type) in PBRMaterial.slots.enumerated() {
+            encoder.setFragmentTexture(textures[type], index: index)
+        }
+        return PBRMaterial.slots.count
     }
 }
 
@@ -13,6 +13,11 @@ enum RendererError: Error {
     case general
 }
 
+struct RenderStats {
+    var bindCount = 0
+    var drawCount = 0
+}
+
 class Renderer {
     
     private let layer: CAMetalLayer
@@ -23,10 +28,14 @@ class Renderer {
     private var depthState: MTLDepthStencilState?
     private var depthTexture: MTLTexture?
     
-    private var nodes = [SceneNode]()
+    private var materials = [Material]()
+    private var uniformBuffer: MTLBuffer?
+    private var lightBuffer: MTLBuffer?
     private var projectionMatrix = simd_float4x4()
     private var frameNumber = 0
     
+    private(set) var frameStats = RenderStats()
+    
     init(layer: CAMetalLayer, scene: FBXScene) {
         self.layer = layer
         self.scene = scene
@@ -51,20 +60,34 @@ class Renderer {
         
         let materialLoader = PBRMaterialLoader()
         let url = URL(fileURLWithPath: scene.path).deletingLastPathComponent().appendingPathComponent("materials.json")
-        let materials = try materialLoader.load(device: device, path: url)
+        let materialMap = try materialLoader.load(device: device, path: url)
+        
+        var materialIds = [ObjectIdentifier : UInt32]()
+        var meshMaterials = [NSNumber]()
         
         for i in 0..<scene.getMeshCount() {
-            guard let uniformBuffer = device.makeBuffer(length: MemoryLayout<Uniforms>.size, options: .storageModeShared) else {
-                throw RendererError.general
+            guard let material = materialMap[scene.getName(i)] else {
+                meshMaterials.append(NSNumber(value: FBXSceneNoMaterial))
+                continue
             }
             
-            nodes.append(SceneNode(
-                indexCount: scene.getIndexCount(i),
-                material: materials[scene.getName(i)],
-                uniformBuffer: uniformBuffer,
-                lightBuffer: lightBuffer)
-            )
+            let key = ObjectIdentifier(material)
+            if materialIds[key] == nil {
+                materialIds[key] = UInt32(materials.count)
+                materials.append(material)
+            }
+            meshMaterials.append(NSNumber(value: materialIds[key]!))
         }
+        
+        scene.buildDrawList(meshMaterials)
+        
+        let uniformLength = MemoryLayout<Uniforms>.stride * max(scene.getDrawCount(), 1)
+        guard let uniformBuffer = device.makeBuffer(length: uniformLength, options: .storageModeShared) else {
+            throw RendererError.general
+        }
+        
+        self.uniformBuffer = uniformBuffer
+        self.lightBuffer = lightBuffer
     }
     
     func draw() {
@@ -79,15 +102,17 @@ class Renderer {
         
         guard let commandBuffer = commandQueue?.makeCommandBuffer(),
             let commandEncoder = commandBuffer.makeRenderCommandEncoder(descriptor: renderPass),
-            let pipelineState = renderPipeline else { return }
+            let pipelineState = renderPipeline,
+            let uniformBuffer = uniformBuffer,
+            let lightBuffer = lightBuffer else { return }
         
         commandEncoder.setRenderPipelineState(pipelineState)
         commandEncoder.setDepthStencilState(depthState)
         commandEncoder.setFrontFacing(.counterClockwise)
         commandEncoder.setCullMode(.back)
         
-        setupLight(scene: scene, buffer: nodes[0].lightBuffer)
-        drawNodesWithCommandEncoder(commandEncoder)
+        setupLight(scene: scene, buffer: lightBuffer)
+        drawNodesWithCommandEncoder(commandEncoder, uniformBuffer: uniformBuffer, lightBuffer: lightBuffer)
         
         commandEncoder.endEncoding()
         
@@ -182,7 +207,7 @@ class Renderer {
         return renderPass
     }
     
-    private func drawNodesWithCommandEncoder(_ encoder: MTLRenderCommandEncoder) {
+    private func drawNodesWithCommandEncoder(_ encoder: MTLRenderCommandEncoder, uniformBuffer: MTLBuffer, lightBuffer: MTLBuffer) {
         frameNumber += 1
         
         scene.render()
@@ -197,34 +222,47 @@ class Renderer {
                                                    target: simd_float3(0.0, 2.0, 0.0),
                                                    up: simd_float3(0.0, 1.0, 0.0)) * rotationMatrix
         
-        for i in 0..<scene.getMeshCount() {
-            let node = nodes[i]
-            
-            if node.material == nil {
-                continue
-            }
-            
-            let p = node.uniformBuffer.contents().bindMemory(to: Uniforms.self, capacity: MemoryLayout<Uniforms>.size)
-            
-            p.pointee.projection_matrix = projectionMatrix
-            p.pointee.view_matrix = viewMatrix
-            p.pointee.model_matrix = scene.getTransformation(i)
-            p.pointee.camera_position = eyePosition
+        let drawCount = scene.getDrawCount()
+        let uniforms = uniformBuffer.contents().bindMemory(to: Uniforms.self, capacity: max(drawCount, 1))
+        
+        var stats = RenderStats()
+        
+        // Geometry, uniforms and lights are shared by all draws and bound once per frame.
+        encoder.setVertexBuffer(scene.getVertexBuffer(), offset: 0, index: 0)
+        encoder.setVertexBuffer(uniformBuffer, offset: 0, index: 1)
+        encoder.setFragmentBuffer(lightBuffer, offset: 0, index: 0)
+        stats.bindCount += 3
+        
+        var currentMaterial: UInt32?
+        
+        for i in 0..<drawCount {
+            let mesh = scene.getDrawMesh(i)
+            let material = scene.getDrawMaterial(i)
             
-            encoder.setVertexBuffer(scene.getVertexBuffer(i), offset: 0, index: 0)
-            encoder.setVertexBuffer(node.uniformBuffer, offset: 0, index: 1)
-            encoder.setFragmentBuffer(node.lightBuffer, offset: 0, index: 0)
+            uniforms[i].projection_matrix = projectionMatrix
+            uniforms[i].view_matrix = viewMatrix
+            uniforms[i].model_matrix = scene.getTransformation(mesh)
+            uniforms[i].camera_position = eyePosition
             
-            node.material?.setTextures(encoder: encoder)
+            if material != currentMaterial {
+                stats.bindCount += materials[Int(material)].setTextures(encoder: encoder)
+                currentMaterial = material
+            }
             
             encoder.drawIndexedPrimitives(
                 type: .triangle,
-                indexCount: node.indexCount,
+                indexCount: scene.getIndexCount(mesh),
                 indexType: .uint32,
-                indexBuffer: scene.getIndexBuffer(i),
-                indexBufferOffset: 0
+                indexBuffer: scene.getIndexBuffer(),
+                indexBufferOffset: scene.getIndexBufferOffset(mesh),
+                instanceCount: 1,
+                baseVertex: scene.getBaseVertex(mesh),
+                baseInstance: i
             )
+            stats.drawCount += 1
         }
+        
+        frameStats = stats
     }
     
     private func setupLight(scene: FBXScene, buffer: MTLBuffer) {
@@ -259,10 +297,3 @@ class Renderer {
         p.pointee.entry.3.color = color
     }
 }
-
-private struct SceneNode {
-    var indexCount: Int
-    var material: Material?
-    var uniformBuffer: MTLBuffer
-    var lightBuffer: MTLBuffer
-}